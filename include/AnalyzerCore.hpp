@@ -0,0 +1,294 @@
+#pragma once
+#include "GraphicTablet.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Templated analysis core behind Analyzer. Sample is the coordinate type
+// (int16_t, int32_t or float); Moments is the accumulator policy.
+namespace analysis {
+
+// osu! playfield as a fraction of the screen
+constexpr double PLAYFIELD_WIDTH_RATIO = 1152.0 / 1920.0;
+constexpr double PLAYFIELD_HEIGHT_RATIO = 864.0 / 1080.0;
+
+constexpr double PI = 3.14159265358979323846;
+
+// Two's-complement 128-bit integer for toolchains without __int128 (MSVC).
+// Only what the moment sums need: +, -, * modulo 2^128 and conversion to double.
+struct Int128 {
+    std::uint64_t hi = 0, lo = 0;
+
+    constexpr Int128() = default;
+    constexpr Int128(std::int64_t v)
+        : hi(v < 0 ? ~std::uint64_t(0) : 0), lo(static_cast<std::uint64_t>(v)) {}
+
+    friend Int128 operator+(Int128 a, Int128 b) {
+        Int128 r;
+        r.lo = a.lo + b.lo;
+        r.hi = a.hi + b.hi + (r.lo < a.lo);
+        return r;
+    }
+
+    friend Int128 operator-(Int128 a, Int128 b) {
+        Int128 r;
+        r.lo = a.lo - b.lo;
+        r.hi = a.hi - b.hi - (a.lo < b.lo);
+        return r;
+    }
+
+    friend Int128 operator*(Int128 a, Int128 b) {
+        Int128 r = mul64(a.lo, b.lo);
+        r.hi += a.hi * b.lo + a.lo * b.hi;
+        return r;
+    }
+
+    Int128& operator+=(Int128 b) { return *this = *this + b; }
+
+    explicit operator double() const {
+        if (hi >> 63) return -static_cast<double>(Int128() - *this);
+        if (hi == 0) return static_cast<double>(lo);
+        // Keep the top 64 significant bits plus a sticky bit so the
+        // conversion rounds once, like a native 128-bit integer would
+        int shift = 0;
+        while (shift < 64 && (hi >> shift) != 0) ++shift;
+        std::uint64_t top = shift == 64 ? hi : (hi << (64 - shift)) | (lo >> shift);
+        if (shift < 64 && (lo & ((std::uint64_t(1) << shift) - 1)) != 0) top |= 1;
+        if (shift == 64 && lo != 0) top |= 1;
+        return std::ldexp(static_cast<double>(top), shift);
+    }
+
+private:
+    // Full 64x64 -> 128 unsigned product from 32-bit halves
+    static Int128 mul64(std::uint64_t a, std::uint64_t b) {
+        std::uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+        std::uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+        std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+        std::uint64_t mid = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+        Int128 r;
+        r.lo = (mid << 32) | (ll & 0xffffffffu);
+        r.hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return r;
+    }
+};
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef __int128 wide_int;
+#else
+using wide_int = Int128;
+#endif
+
+// (n·Σab − Σa·Σb) / n², with the subtraction done exactly.
+// Shared by ExactMoments and the session summaries in StatsStore.
+template <typename Product>
+double centered(std::int64_t n, std::int64_t a, std::int64_t b, Product ab) {
+    wide_int num = static_cast<wide_int>(n) * static_cast<wide_int>(ab)
+                 - static_cast<wide_int>(a) * static_cast<wide_int>(b);
+    return static_cast<double>(num) / (static_cast<double>(n) * n);
+}
+
+// Exact integer sums. Products of int16 samples fit int64 for any
+// realistic session; int32 products need the wide type.
+template <typename Sample>
+class ExactMoments {
+    static_assert(std::is_integral_v<Sample>, "ExactMoments needs an integer sample type");
+
+public:
+    using sum_type = std::int64_t;
+    using product_type = std::conditional_t<(sizeof(Sample) <= 2), std::int64_t, wide_int>;
+
+    void add(Sample x, Sample y) {
+        ++n;
+        sx += x;
+        sy += y;
+        sxx += static_cast<product_type>(x) * static_cast<product_type>(x);
+        syy += static_cast<product_type>(y) * static_cast<product_type>(y);
+        sxy += static_cast<product_type>(x) * static_cast<product_type>(y);
+    }
+
+    std::int64_t count() const { return n; }
+    double meanX() const { return static_cast<double>(sx) / n; }
+    double meanY() const { return static_cast<double>(sy) / n; }
+    double varX() const { return centered(n, sx, sx, sxx); }
+    double varY() const { return centered(n, sy, sy, syy); }
+    double covXY() const { return centered(n, sx, sy, sxy); }
+
+private:
+    std::int64_t n = 0;
+    sum_type sx = 0, sy = 0;
+    product_type sxx = 0, syy = 0, sxy = 0;
+};
+
+// Welford updates for floating-point samples; never subtracts two large
+// raw sums, so variance stays accurate far from the origin.
+template <typename Sample>
+class WelfordMoments {
+public:
+    void add(Sample x, Sample y) {
+        ++n;
+        double dx = x - mx;
+        mx += dx / n;
+        double dy = y - my;
+        my += dy / n;
+        m2x += dx * (x - mx);
+        m2y += dy * (y - my);
+        cxy += dx * (y - my);
+    }
+
+    std::int64_t count() const { return n; }
+    double meanX() const { return mx; }
+    double meanY() const { return my; }
+    double varX() const { return m2x / n; }
+    double varY() const { return m2y / n; }
+    double covXY() const { return cxy / n; }
+
+private:
+    std::int64_t n = 0;
+    double mx = 0.0, my = 0.0;
+    double m2x = 0.0, m2y = 0.0, cxy = 0.0;
+};
+
+template <typename Sample>
+using DefaultMoments = std::conditional_t<std::is_integral_v<Sample>, ExactMoments<Sample>, WelfordMoments<Sample>>;
+
+struct AnalysisResult {
+    float x_mm;
+    float y_mm;
+    float rotation_deg;
+};
+
+template <typename Sample>
+std::pair<Sample, Sample> find_peak_near_extremes(
+    const std::vector<Sample>& values,
+    Sample min_val,
+    Sample max_val,
+    float threshold_percentage = 5.0f
+) {
+    PROFILE_SCOPE("find_peak_near_extremes");
+    float threshold_range = (max_val - min_val) * (threshold_percentage / 100.0f);
+
+    std::unordered_map<Sample, int> min_counts, max_counts;
+    for (Sample val : values) {
+        if (val <= min_val + threshold_range) {
+            min_counts[val]++;
+        }
+        if (val >= max_val - threshold_range) {
+            max_counts[val]++;
+        }
+    }
+
+    Sample min_peak = min_val;
+    Sample max_peak = max_val;
+    int max_min_freq = 0;
+    int max_max_freq = 0;
+
+    for (const auto& [val, freq] : min_counts) {
+        if (freq > max_min_freq) {
+            max_min_freq = freq;
+            min_peak = val;
+        }
+    }
+
+    for (const auto& [val, freq] : max_counts) {
+        if (freq > max_max_freq) {
+            max_max_freq = freq;
+            max_peak = val;
+        }
+    }
+
+    return {min_peak, max_peak};
+}
+
+// Strictly within ±3σ of the mean
+inline bool in_sigma_band(double val, double mean, double stddev) {
+    return val > mean - 3 * stddev && val < mean + 3 * stddev;
+}
+
+// Principal-axis angle from the moments of a set of (x, y) points
+template <typename Moments>
+float compute_rotation_deg(const Moments& m) {
+    PROFILE_SCOPE("compute_rotation_deg");
+    if (m.count() == 0) return 0.0f;
+
+    double angle_rad = 0.5 * std::atan2(2 * m.covXY(), m.varX() - m.varY());
+    return static_cast<float>(angle_rad * (180.0 / PI));
+}
+
+template <typename Sample, typename Moments = DefaultMoments<Sample>>
+class BasicAnalyzer {
+public:
+    BasicAnalyzer(const Tablet& t, int sw, int sh)
+        : tablet(t), screen_width(sw), screen_height(sh) {}
+
+    // Empty if nothing survives the ±3σ filter (e.g. the cursor never moved)
+    std::optional<AnalysisResult> analyze(const std::vector<Sample>& x, const std::vector<Sample>& y) const {
+        if (x.empty() || x.size() != y.size()) return std::nullopt;
+
+        Moments all;
+        {
+            PROFILE_SCOPE("mean_stddev");
+            for (size_t i = 0; i < x.size(); ++i) {
+                all.add(x[i], y[i]);
+            }
+        }
+
+        std::vector<Sample> x_filtered, y_filtered;
+        Moments paired;
+        filter_sigma(x, y, all, x_filtered, y_filtered, paired);
+        if (x_filtered.empty() || y_filtered.empty()) return std::nullopt;
+
+        float rotation_deg = compute_rotation_deg(paired);
+
+        auto [x_min_it, x_max_it] = std::minmax_element(x_filtered.begin(), x_filtered.end());
+        auto [y_min_it, y_max_it] = std::minmax_element(y_filtered.begin(), y_filtered.end());
+
+        auto [x_min_peak, x_max_peak] = find_peak_near_extremes(x_filtered, *x_min_it, *x_max_it);
+        auto [y_min_peak, y_max_peak] = find_peak_near_extremes(y_filtered, *y_min_it, *y_max_it);
+
+        float x_distance_px = static_cast<float>(x_max_peak - x_min_peak);
+        float y_distance_px = static_cast<float>(y_max_peak - y_min_peak);
+
+        int inner_width_px = static_cast<int>(PLAYFIELD_WIDTH_RATIO * screen_width);
+        int inner_height_px = static_cast<int>(PLAYFIELD_HEIGHT_RATIO * screen_height);
+
+        return AnalysisResult{
+            (x_distance_px * tablet.getWidth()) / inner_width_px,
+            (y_distance_px * tablet.getHeight()) / inner_height_px,
+            rotation_deg
+        };
+    }
+
+private:
+    const Tablet& tablet;
+    int screen_width;
+    int screen_height;
+
+    // ±3σ filter. The area step keeps each axis's samples on their own, as
+    // before; the rotation fit only takes points with both coordinates in band,
+    // accumulated into `paired` so x and y stay matched.
+    static void filter_sigma(
+        const std::vector<Sample>& x, const std::vector<Sample>& y, const Moments& m,
+        std::vector<Sample>& x_out, std::vector<Sample>& y_out, Moments& paired
+    ) {
+        PROFILE_SCOPE("filter_sigma");
+        double x_mean = m.meanX(), x_std = std::sqrt(m.varX());
+        double y_mean = m.meanY(), y_std = std::sqrt(m.varY());
+        x_out.reserve(x.size());
+        y_out.reserve(y.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            bool x_in = in_sigma_band(x[i], x_mean, x_std);
+            bool y_in = in_sigma_band(y[i], y_mean, y_std);
+            if (x_in) x_out.push_back(x[i]);
+            if (y_in) y_out.push_back(y[i]);
+            if (x_in && y_in) paired.add(x[i], y[i]);
+        }
+    }
+};
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped trace spans for --profile runs. Each thread buffers its own
+// events, which are written out as Chrome trace-event JSON at the end.
+// Unless configured with -DTABLET_ANALYZER_PROFILING=ON, PROFILE_SCOPE
+// expands to nothing.
+namespace Profiler {
+    void enable();
+    bool isEnabled();
+
+    // Call once all profiled threads have finished.
+    bool writeChromeTrace(const std::string& path);
+
+#ifdef TABLET_ANALYZER_PROFILING
+    class Span {
+    public:
+        explicit Span(const char* name);
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+        std::uint64_t allocs_at_start;
+    };
+#endif
+}
+
+#ifdef TABLET_ANALYZER_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::Span PROFILE_CONCAT(profile_span_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
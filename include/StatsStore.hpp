@@ -0,0 +1,83 @@
+#pragma once
+#include "GraphicTablet.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Mergeable summary of one or more recording sessions. Merging is a fixed
+// amount of work regardless of how many samples went into either side.
+struct SessionSummary {
+    // Histogram bins across the screen
+    static constexpr int BINS = 1024;
+
+    // Raw moment sums, in screen pixels
+    struct Moments {
+        std::int64_t count = 0;
+        std::int64_t sum_x = 0, sum_y = 0;
+        std::int64_t sum_xx = 0, sum_yy = 0, sum_xy = 0;
+
+        void add(int x, int y);
+        void merge(const Moments& other);
+    };
+
+    std::int64_t timestamp = 0;
+    std::string player;
+    std::string brand;
+    std::string model;
+    int screen_width = 0;
+    int screen_height = 0;
+
+    // Every sample, and the points that passed the session's ±3σ filter
+    Moments all;
+    Moments filtered;
+
+    std::array<std::int64_t, BINS> hist_x{};
+    std::array<std::int64_t, BINS> hist_y{};
+
+    static SessionSummary fromPoints(
+        const std::string& player, const Tablet& tablet,
+        int screen_width, int screen_height,
+        const std::vector<std::pair<int, int>>& data
+    );
+
+    void merge(const SessionSummary& other);
+
+    // Pooled principal-axis angle of the ±3σ-filtered points
+    float rotationDeg() const;
+};
+
+// Append-only, line-per-session store. Each record goes out in a single
+// atomic append, so several processes can write to the same file. Records
+// torn by a crashed writer are skipped on read without losing the next one.
+class StatsStore {
+public:
+    explicit StatsStore(std::string path);
+
+    bool append(const SessionSummary& summary) const;
+
+    struct History {
+        std::optional<SessionSummary> lifetime;
+        std::optional<SessionSummary> recent;
+    };
+
+    // Merge every session for this player, tablet and screen in one pass
+    // over the log: all of them into `lifetime`, and those recorded at or
+    // after `since` (unix seconds) into `recent`. Each is empty if no
+    // session qualifies.
+    History history(
+        const std::string& player, const Tablet& tablet,
+        int screen_width, int screen_height,
+        std::int64_t since
+    ) const;
+
+    // Used area in mm. Same rule Analyzer applies to raw samples for its
+    // area: each axis is filtered on its own to the ±3σ band of all samples,
+    // then peak-near-extremes picks the edges. Here it runs on histogram bins.
+    static std::pair<float, float> areaMm(const SessionSummary& summary, const Tablet& tablet);
+
+private:
+    std::string path;
+};
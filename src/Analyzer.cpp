@@ -1,138 +1,64 @@
 #include "Analyzer.hpp"
+#include "AnalyzerCore.hpp"
+#include "Profiler.hpp"
+#include <cstdint>
 #include <iostream>
-#include <cmath>
-#include <algorithm>
-#include <unordered_map>
-#include <vector>
-#include <numeric>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <limits>
 
 Analyzer::Analyzer(const Tablet& t, int sw, int sh)
     : tablet(t), screen_width(sw), screen_height(sh) {}
 
-static std::pair<int, int> find_peak_near_extremes(
-    const std::vector<int>& values,
-    int min_val,
-    int max_val,
-    float threshold_percentage = 5.0f
+// Split into per-axis vectors of Sample. Fails as soon as a coordinate
+// does not fit, so the common narrow case is a single pass over data.
+template <typename Sample>
+static bool split_axes(
+    const std::vector<std::pair<int, int>>& data,
+    std::vector<Sample>& x, std::vector<Sample>& y
 ) {
-    float threshold_range = (max_val - min_val) * (threshold_percentage / 100.0f);
-
-    std::unordered_map<int, int> min_counts, max_counts;
-    for (int val : values) {
-        if (val <= min_val + threshold_range) {
-            min_counts[val]++;
-        }
-        if (val >= max_val - threshold_range) {
-            max_counts[val]++;
-        }
-    }
-
-    int min_peak = min_val;
-    int max_peak = max_val;
-    int max_min_freq = 0;
-    int max_max_freq = 0;
-
-    for (const auto& [val, freq] : min_counts) {
-        if (freq > max_min_freq) {
-            max_min_freq = freq;
-            min_peak = val;
-        }
-    }
-
-    for (const auto& [val, freq] : max_counts) {
-        if (freq > max_max_freq) {
-            max_max_freq = freq;
-            max_peak = val;
-        }
+    PROFILE_SCOPE("split_axes");
+    constexpr int lo = std::numeric_limits<Sample>::min();
+    constexpr int hi = std::numeric_limits<Sample>::max();
+    x.reserve(data.size());
+    y.reserve(data.size());
+    for (const auto& [px, py] : data) {
+        if (px < lo || px > hi || py < lo || py > hi) return false;
+        x.push_back(static_cast<Sample>(px));
+        y.push_back(static_cast<Sample>(py));
     }
-
-    return {min_peak, max_peak};
+    return true;
 }
 
-float compute_rotation_deg(const std::vector<int>& x, const std::vector<int>& y) {
-    float mean_x = std::accumulate(x.begin(), x.end(), 0.0f) / x.size();
-    float mean_y = std::accumulate(y.begin(), y.end(), 0.0f) / y.size();
-
-    float sxx = 0.0f, sxy = 0.0f;
-    for (size_t i = 0; i < x.size(); ++i) {
-        float dx = x[i] - mean_x;
-        float dy = y[i] - mean_y;
-        sxx += dx * dx;
-        sxy += dx * dy;
-    }
-
-    float angle_rad = std::atan2(2 * sxy, sxx - (std::accumulate(y.begin(), y.end(), 0.0f,
-                      [&](float acc, float yi) {
-                          float dy = yi - mean_y;
-                          return acc + dy * dy;
-                      })));
-    angle_rad *= 0.5f;
-
-    float angle_deg = angle_rad * (180.0f / M_PI);
-    return angle_deg;
+template <typename Sample>
+static std::optional<analysis::AnalysisResult> run(
+    const Tablet& tablet, int screen_width, int screen_height,
+    const std::vector<Sample>& x, const std::vector<Sample>& y
+) {
+    return analysis::BasicAnalyzer<Sample>(tablet, screen_width, screen_height).analyze(x, y);
 }
 
 void Analyzer::analyze(const std::vector<std::pair<int, int>>& data) const {
+    PROFILE_SCOPE("Analyzer::analyze");
     if (data.empty()) return;
 
-    std::vector<int> x, y;
-    for (const auto& [px, py] : data) {
-        x.push_back(px);
-        y.push_back(py);
+    std::optional<analysis::AnalysisResult> result;
+    std::vector<std::int16_t> x16, y16;
+    if (split_axes(data, x16, y16)) {
+        result = run(tablet, screen_width, screen_height, x16, y16);
+    } else {
+        // Free the abandoned int16 buffers before building the int32 ones
+        std::vector<std::int16_t>().swap(x16);
+        std::vector<std::int16_t>().swap(y16);
+        std::vector<std::int32_t> x32, y32;
+        split_axes(data, x32, y32);
+        result = run(tablet, screen_width, screen_height, x32, y32);
     }
 
-    auto mean_stddev = [](const std::vector<int>& v) -> std::pair<float, float> {
-        float mean = std::accumulate(v.begin(), v.end(), 0.0f) / v.size();
-        float sum = 0.0f;
-        for (float val : v) {
-            sum += (val - mean) * (val - mean);
-        }
-        float stddev = std::sqrt(sum / v.size());
-        return {mean, stddev};
-    };
-
-    // Filter ±3σ
-    auto filter_sigma = [](const std::vector<int>& input, float mean, float stddev) {
-        std::vector<int> filtered;
-        for (int val : input) {
-            if (val > mean - 3 * stddev && val < mean + 3 * stddev) {
-                filtered.push_back(val);
-            }
-        }
-        return filtered;
-    };
-
-    auto [x_mean, x_std] = mean_stddev(x);
-    auto [y_mean, y_std] = mean_stddev(y);
-
-    std::vector<int> x_filtered = filter_sigma(x, x_mean, x_std);
-    std::vector<int> y_filtered = filter_sigma(y, y_mean, y_std);
-    float rotation_deg = compute_rotation_deg(x_filtered, y_filtered);
-
-    auto [x_min_it, x_max_it] = std::minmax_element(x_filtered.begin(), x_filtered.end());
-    auto [y_min_it, y_max_it] = std::minmax_element(y_filtered.begin(), y_filtered.end());
-
-    int x_min = *x_min_it, x_max = *x_max_it;
-    int y_min = *y_min_it, y_max = *y_max_it;
-
-    auto [x_min_peak, x_max_peak] = find_peak_near_extremes(x_filtered, x_min, x_max);
-    auto [y_min_peak, y_max_peak] = find_peak_near_extremes(y_filtered, y_min, y_max);
-
-    int x_distance_px = x_max_peak - x_min_peak;
-    int y_distance_px = y_max_peak - y_min_peak;
-
-    int inner_width_px = static_cast<int>((1152.0 / 1920.0) * screen_width);
-    int inner_height_px = static_cast<int>((864.0 / 1080.0) * screen_height);
-
-    float x_mm = (x_distance_px * tablet.getWidth()) / inner_width_px;
-    float y_mm = (y_distance_px * tablet.getHeight()) / inner_height_px;
-
     std::cout << "\n==== RESULTS ====\n";
-    std::cout << "Used Area (filtered and peak-aligned): " << x_mm << " x " << y_mm << " mm\n";
-    std::cout << "Rotation angle (degrees): " << rotation_deg << "°\n";
+    if (!result) {
+        std::cout << "Not enough cursor movement recorded.\n";
+    } else {
+        std::cout << "Used Area (filtered and peak-aligned): " << result->x_mm << " x " << result->y_mm << " mm\n";
+        std::cout << "Rotation angle (degrees): " << result->rotation_deg << "°\n";
+    }
     std::cout << "=================\n";
 }
@@ -0,0 +1,128 @@
+#include "Profiler.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef TABLET_ANALYZER_PROFILING
+
+namespace {
+    struct Event {
+        const char* name;
+        double ts_us;
+        double dur_us;
+        std::uint64_t allocs;
+    };
+
+    struct ThreadLog {
+        int tid;
+        std::vector<Event> events;
+    };
+
+    std::atomic<bool> enabled{false};
+    // steady_clock ticks at enable(); read from every profiled thread
+    std::atomic<std::int64_t> epoch_ticks{0};
+
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<ThreadLog>> registry;
+
+    // Plain counter so operator new can bump it without recursing.
+    thread_local std::uint64_t alloc_count = 0;
+    thread_local ThreadLog* thread_log = nullptr;
+    // Set while the profiler grows its own buffers, so those allocations
+    // are not charged to the spans still open on this thread
+    thread_local bool in_bookkeeping = false;
+
+    struct BookkeepingScope {
+        BookkeepingScope() { in_bookkeeping = true; }
+        ~BookkeepingScope() { in_bookkeeping = false; }
+    };
+
+    ThreadLog& local_log() {
+        if (!thread_log) {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            registry.push_back(std::make_unique<ThreadLog>());
+            thread_log = registry.back().get();
+            thread_log->tid = static_cast<int>(registry.size());
+        }
+        return *thread_log;
+    }
+
+    // Fractional microseconds so nested spans stay nested in the viewer
+    double to_us(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    }
+}
+
+void* operator new(std::size_t size) {
+    if (!in_bookkeeping && enabled.load(std::memory_order_relaxed)) ++alloc_count;
+    if (size == 0) size = 1;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace Profiler {
+    void enable() {
+        epoch_ticks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        enabled.store(true, std::memory_order_release);
+    }
+
+    bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    Span::Span(const char* n)
+        : name(n), active(isEnabled()), allocs_at_start(alloc_count) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+
+    Span::~Span() {
+        if (!active) return;
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point epoch{
+            std::chrono::steady_clock::duration(epoch_ticks.load(std::memory_order_relaxed))
+        };
+        std::uint64_t allocs = alloc_count - allocs_at_start;
+        BookkeepingScope bookkeeping;
+        local_log().events.push_back({name, to_us(start - epoch), to_us(end - start), allocs});
+    }
+
+    bool writeChromeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& log : registry) {
+            for (const auto& e : log->events) {
+                if (!first) out << ",";
+                first = false;
+                out << "\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1"
+                    << ",\"tid\":" << log->tid
+                    << ",\"ts\":" << e.ts_us
+                    << ",\"dur\":" << e.dur_us
+                    << ",\"args\":{\"allocs\":" << e.allocs << "}}";
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return static_cast<bool>(out);
+    }
+}
+
+#else
+
+namespace Profiler {
+    void enable() {}
+    bool isEnabled() { return false; }
+    bool writeChromeTrace(const std::string&) { return false; }
+}
+
+#endif
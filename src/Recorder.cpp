@@ -1,4 +1,5 @@
 #include "Recorder.hpp"
+#include "Profiler.hpp"
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -15,6 +16,7 @@
 Recorder::Recorder(int duration) : duration_sec(duration) {}
 
 std::pair<int, int> Recorder::getCursorPosition() const {
+    PROFILE_SCOPE("Recorder::getCursorPosition");
 #ifdef _WIN32
     POINT p;
     if (GetCursorPos(&p)) {
@@ -48,6 +50,7 @@ std::pair<int, int> Recorder::getCursorPosition() const {
 }
 
 std::vector<std::pair<int, int>> Recorder::record() const {
+    PROFILE_SCOPE("Recorder::record");
     std::vector<std::pair<int, int>> points;
     using namespace std::chrono_literals;
 
@@ -0,0 +1,304 @@
+#include "StatsStore.hpp"
+#include "AnalyzerCore.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Record layout, tab separated:
+// S2 ts player brand model sw sh <all: n sx sy sxx syy sxy> <filtered: same> hist_x hist_y E
+// Histograms are sparse "bin:count" lists joined by ','.
+static constexpr const char* RECORD_TAG = "S2";
+static constexpr const char* RECORD_END = "E";
+static constexpr size_t RECORD_FIELDS = 22;
+
+// Matches Analyzer's peak-near-extremes window
+static constexpr float PEAK_THRESHOLD_PERCENTAGE = 5.0f;
+
+using Histogram = std::array<std::int64_t, SessionSummary::BINS>;
+
+static int bin_of(int v, int extent) {
+    if (extent <= 0) return 0;
+    long long b = static_cast<long long>(v) * SessionSummary::BINS / extent;
+    return static_cast<int>(std::clamp<long long>(b, 0, SessionSummary::BINS - 1));
+}
+
+static double bin_center(int b, int extent) {
+    return (b + 0.5) * extent / SessionSummary::BINS;
+}
+
+// ±3σ filter followed by find_peak_near_extremes, on bin centres.
+// Returns the peak-to-peak distance in pixels.
+static float binned_span(const Histogram& hist, int extent, double mean, double stddev) {
+    int lo = -1, hi = -1;
+    for (int b = 0; b < SessionSummary::BINS; ++b) {
+        if (hist[b] == 0 || !analysis::in_sigma_band(bin_center(b, extent), mean, stddev)) continue;
+        if (lo < 0) lo = b;
+        hi = b;
+    }
+    if (lo < 0) return 0.0f;
+
+    float threshold_bins = (hi - lo) * (PEAK_THRESHOLD_PERCENTAGE / 100.0f);
+    int min_peak = lo, max_peak = hi;
+    for (int b = lo; b <= hi; ++b) {
+        if (b <= lo + threshold_bins && hist[b] > hist[min_peak]) min_peak = b;
+        if (b >= hi - threshold_bins && hist[b] > hist[max_peak]) max_peak = b;
+    }
+    return static_cast<float>(bin_center(max_peak, extent) - bin_center(min_peak, extent));
+}
+
+static std::string sanitize(const std::string& s) {
+    std::string out = s;
+    std::replace_if(out.begin(), out.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return out;
+}
+
+static void write_moments(std::ostream& out, const SessionSummary::Moments& m) {
+    out << '\t' << m.count << '\t' << m.sum_x << '\t' << m.sum_y
+        << '\t' << m.sum_xx << '\t' << m.sum_yy << '\t' << m.sum_xy;
+}
+
+static void read_moments(const std::vector<std::string>& fields, size_t first, SessionSummary::Moments& m) {
+    m.count = std::stoll(fields[first]);
+    m.sum_x = std::stoll(fields[first + 1]);
+    m.sum_y = std::stoll(fields[first + 2]);
+    m.sum_xx = std::stoll(fields[first + 3]);
+    m.sum_yy = std::stoll(fields[first + 4]);
+    m.sum_xy = std::stoll(fields[first + 5]);
+}
+
+static void write_hist(std::ostream& out, const Histogram& hist) {
+    bool first = true;
+    for (int b = 0; b < SessionSummary::BINS; ++b) {
+        if (hist[b] == 0) continue;
+        if (!first) out << ',';
+        first = false;
+        out << b << ':' << hist[b];
+    }
+}
+
+static bool read_hist(const std::string& field, Histogram& hist) {
+    std::istringstream in(field);
+    std::string entry;
+    while (std::getline(in, entry, ',')) {
+        int b;
+        long long c;
+        char colon;
+        std::istringstream e(entry);
+        if (!(e >> b >> colon >> c) || colon != ':' || b < 0 || b >= SessionSummary::BINS) return false;
+        hist[b] += c;
+    }
+    return true;
+}
+
+static bool parse_record(const std::string& line, SessionSummary& s) {
+    std::vector<std::string> fields;
+    std::istringstream in(line);
+    std::string field;
+    while (std::getline(in, field, '\t')) fields.push_back(field);
+    if (fields.size() != RECORD_FIELDS || fields.front() != RECORD_TAG || fields.back() != RECORD_END)
+        return false;
+
+    try {
+        s.timestamp = std::stoll(fields[1]);
+        s.player = fields[2];
+        s.brand = fields[3];
+        s.model = fields[4];
+        s.screen_width = std::stoi(fields[5]);
+        s.screen_height = std::stoi(fields[6]);
+        read_moments(fields, 7, s.all);
+        read_moments(fields, 13, s.filtered);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return read_hist(fields[19], s.hist_x) && read_hist(fields[20], s.hist_y);
+}
+
+// A writer that died mid-record leaves a line with no '\n', so the next
+// record is glued onto it. Try each record tag in the line, earliest first.
+static bool parse_line(const std::string& line, SessionSummary& s) {
+    const std::string tag = std::string(RECORD_TAG) + '\t';
+    for (size_t pos = line.find(tag); pos != std::string::npos; pos = line.find(tag, pos + 1)) {
+        if (parse_record(line.substr(pos), s)) return true;
+        s = SessionSummary();
+    }
+    return false;
+}
+
+// True if the file is missing, empty or ends in '\n'
+static bool ends_with_newline(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in || in.tellg() <= 0) return true;
+    in.seekg(-1, std::ios::end);
+    char last = 0;
+    in.get(last);
+    return last == '\n';
+}
+
+void SessionSummary::Moments::add(int x, int y) {
+    ++count;
+    sum_x += x;
+    sum_y += y;
+    sum_xx += static_cast<std::int64_t>(x) * x;
+    sum_yy += static_cast<std::int64_t>(y) * y;
+    sum_xy += static_cast<std::int64_t>(x) * y;
+}
+
+void SessionSummary::Moments::merge(const Moments& other) {
+    count += other.count;
+    sum_x += other.sum_x;
+    sum_y += other.sum_y;
+    sum_xx += other.sum_xx;
+    sum_yy += other.sum_yy;
+    sum_xy += other.sum_xy;
+}
+
+SessionSummary SessionSummary::fromPoints(
+    const std::string& player, const Tablet& tablet,
+    int screen_width, int screen_height,
+    const std::vector<std::pair<int, int>>& data
+) {
+    PROFILE_SCOPE("SessionSummary::fromPoints");
+    SessionSummary s;
+    s.timestamp = static_cast<std::int64_t>(std::time(nullptr));
+    s.player = player;
+    s.brand = std::string(tablet.getBrand());
+    s.model = std::string(tablet.getModel());
+    s.screen_width = screen_width;
+    s.screen_height = screen_height;
+    for (const auto& [x, y] : data) {
+        s.all.add(x, y);
+        ++s.hist_x[bin_of(x, screen_width)];
+        ++s.hist_y[bin_of(y, screen_height)];
+    }
+    if (s.all.count == 0) return s;
+
+    // Same joint ±3σ filter Analyzer applies before fitting the rotation
+    const Moments& m = s.all;
+    double x_mean = static_cast<double>(m.sum_x) / m.count;
+    double y_mean = static_cast<double>(m.sum_y) / m.count;
+    double x_std = std::sqrt(analysis::centered(m.count, m.sum_x, m.sum_x, m.sum_xx));
+    double y_std = std::sqrt(analysis::centered(m.count, m.sum_y, m.sum_y, m.sum_yy));
+    for (const auto& [x, y] : data) {
+        if (analysis::in_sigma_band(x, x_mean, x_std) && analysis::in_sigma_band(y, y_mean, y_std)) {
+            s.filtered.add(x, y);
+        }
+    }
+    return s;
+}
+
+void SessionSummary::merge(const SessionSummary& other) {
+    timestamp = std::max(timestamp, other.timestamp);
+    all.merge(other.all);
+    filtered.merge(other.filtered);
+    for (int b = 0; b < BINS; ++b) {
+        hist_x[b] += other.hist_x[b];
+        hist_y[b] += other.hist_y[b];
+    }
+}
+
+float SessionSummary::rotationDeg() const {
+    const Moments& m = filtered;
+    if (m.count == 0) return 0.0f;
+    double sxx = analysis::centered(m.count, m.sum_x, m.sum_x, m.sum_xx);
+    double syy = analysis::centered(m.count, m.sum_y, m.sum_y, m.sum_yy);
+    double sxy = analysis::centered(m.count, m.sum_x, m.sum_y, m.sum_xy);
+    double angle_rad = 0.5 * std::atan2(2 * sxy, sxx - syy);
+    return static_cast<float>(angle_rad * (180.0 / analysis::PI));
+}
+
+StatsStore::StatsStore(std::string p) : path(std::move(p)) {}
+
+bool StatsStore::append(const SessionSummary& s) const {
+    PROFILE_SCOPE("StatsStore::append");
+    std::ostringstream out;
+    // Terminate a record torn by a crashed writer so ours starts a fresh line.
+    // Racing another append in flight can add a spare blank line; readers skip it.
+    if (!ends_with_newline(path)) out << '\n';
+    out << RECORD_TAG << '\t' << s.timestamp
+        << '\t' << sanitize(s.player) << '\t' << sanitize(s.brand) << '\t' << sanitize(s.model)
+        << '\t' << s.screen_width << '\t' << s.screen_height;
+    write_moments(out, s.all);
+    write_moments(out, s.filtered);
+    out << '\t';
+    write_hist(out, s.hist_x);
+    out << '\t';
+    write_hist(out, s.hist_y);
+    out << '\t' << RECORD_END << '\n';
+    const std::string record = out.str();
+
+    // One append-mode write per record keeps concurrent writers from
+    // interleaving; the CRT's _O_APPEND seeks and writes separately
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    bool ok = WriteFile(file, record.data(), static_cast<DWORD>(record.size()), &written, nullptr)
+              && written == record.size();
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return false;
+    bool ok = ::write(fd, record.data(), record.size()) == static_cast<ssize_t>(record.size());
+    ::close(fd);
+#endif
+    return ok;
+}
+
+StatsStore::History StatsStore::history(
+    const std::string& player, const Tablet& tablet,
+    int screen_width, int screen_height,
+    std::int64_t since
+) const {
+    PROFILE_SCOPE("StatsStore::history");
+    History h;
+    std::ifstream in(path);
+    if (!in) return h;
+
+    const std::string wanted_player = sanitize(player);
+    std::string line;
+    while (std::getline(in, line)) {
+        SessionSummary s;
+        if (!parse_line(line, s)) continue;
+        if (s.player != wanted_player || s.brand != tablet.getBrand() || s.model != tablet.getModel())
+            continue;
+        if (s.screen_width != screen_width || s.screen_height != screen_height) continue;
+
+        if (s.timestamp >= since) {
+            if (h.recent) h.recent->merge(s);
+            else h.recent = s;
+        }
+        if (h.lifetime) h.lifetime->merge(s);
+        else h.lifetime = std::move(s);
+    }
+    return h;
+}
+
+std::pair<float, float> StatsStore::areaMm(const SessionSummary& s, const Tablet& tablet) {
+    int inner_width_px = static_cast<int>(analysis::PLAYFIELD_WIDTH_RATIO * s.screen_width);
+    int inner_height_px = static_cast<int>(analysis::PLAYFIELD_HEIGHT_RATIO * s.screen_height);
+    const SessionSummary::Moments& m = s.all;
+    if (inner_width_px <= 0 || inner_height_px <= 0 || m.count == 0) return {0.0f, 0.0f};
+
+    double x_mean = static_cast<double>(m.sum_x) / m.count;
+    double y_mean = static_cast<double>(m.sum_y) / m.count;
+    double x_std = std::sqrt(analysis::centered(m.count, m.sum_x, m.sum_x, m.sum_xx));
+    double y_std = std::sqrt(analysis::centered(m.count, m.sum_y, m.sum_y, m.sum_yy));
+
+    float x_px = binned_span(s.hist_x, s.screen_width, x_mean, x_std);
+    float y_px = binned_span(s.hist_y, s.screen_height, y_mean, y_std);
+    return {x_px * tablet.getWidth() / inner_width_px, y_px * tablet.getHeight() / inner_height_px};
+}
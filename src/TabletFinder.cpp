@@ -1,11 +1,13 @@
 // File: src/TabletFinder.cpp
 #include "TabletFinder.hpp"
+#include "Profiler.hpp"
 
 TabletFinder::TabletFinder() {
     loadTablets();
 }
 
 void TabletFinder::loadTablets() {
+    PROFILE_SCOPE("TabletFinder::loadTablets");
     tablets = {
         Tablet("Artisul", "D16 Pro", 344.17, 193.57),
         Tablet("Artisul", "A1201", 258.45, 171.55),
@@ -296,6 +298,7 @@ void TabletFinder::loadTablets() {
 }
 
 std::optional<Tablet> TabletFinder::find(std::string_view brand, std::string_view model) const {
+    PROFILE_SCOPE("TabletFinder::find");
     for (const auto& t : tablets) {
         if (t.getBrand() == brand && t.getModel() == model) {
             return t;
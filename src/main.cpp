@@ -2,13 +2,53 @@
 #include "Recorder.hpp"
 #include "Analyzer.hpp"
 #include "PickMenu.hpp"
+#include "Profiler.hpp"
+#include "StatsStore.hpp"
 #include <iostream>
 #include <string>
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+int main(int argc, char* argv[]) {
+    // --profile[=path] writes a Chrome trace of this run (default trace.json)
+    // --player=name keeps per-player history in --store=path (default area_stats.log)
+    std::string trace_path;
+    std::string player;
+    std::string store_path = "area_stats.log";
+    int rolling_days = 7;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--profile") {
+            trace_path = "trace.json";
+        } else if (arg.rfind("--profile=", 0) == 0) {
+            trace_path = arg.substr(10);
+        } else if (arg.rfind("--player=", 0) == 0) {
+            player = arg.substr(9);
+        } else if (arg.rfind("--store=", 0) == 0) {
+            store_path = arg.substr(8);
+        } else if (arg.rfind("--days=", 0) == 0) {
+            rolling_days = std::max(1, std::atoi(arg.c_str() + 7));
+        }
+    }
+    if (!trace_path.empty()) {
+#ifdef TABLET_ANALYZER_PROFILING
+        Profiler::enable();
+#else
+        std::cerr << "Built without TABLET_ANALYZER_PROFILING; --profile ignored.\n";
+        trace_path.clear();
+#endif
+    }
+    auto write_profile = [&trace_path]() {
+        if (trace_path.empty()) return;
+        if (Profiler::writeChromeTrace(trace_path))
+            std::cout << "Profile written to " << trace_path << "\n";
+        else
+            std::cerr << "Could not write profile to " << trace_path << "\n";
+    };
 
-int main() {
     TabletFinder finder;
 
     // 1. Gather unique brands
@@ -40,6 +80,7 @@ int main() {
     auto tablet_opt = finder.find(selected_brand, selected_model);
     if (!tablet_opt) {
         std::cerr << "Tablet not found.\n";
+        write_profile();
         return 1;
     }
 
@@ -59,5 +100,29 @@ int main() {
     Analyzer analyzer(*tablet_opt, screen_w, screen_h);
     analyzer.analyze(points);
 
+    if (!player.empty() && !points.empty()) {
+        StatsStore store(store_path);
+        if (!store.append(SessionSummary::fromPoints(player, *tablet_opt, screen_w, screen_h, points))) {
+            std::cerr << "Could not append session to " << store_path << "\n";
+        }
+
+        std::int64_t since = static_cast<std::int64_t>(std::time(nullptr)) - std::int64_t(rolling_days) * 24 * 60 * 60;
+        auto [lifetime, recent] = store.history(player, *tablet_opt, screen_w, screen_h, since);
+
+        std::cout << "\n==== HISTORY (" << player << ") ====\n";
+        if (lifetime) {
+            auto [x_mm, y_mm] = StatsStore::areaMm(*lifetime, *tablet_opt);
+            std::cout << "Lifetime area (binned): " << x_mm << " x " << y_mm << " mm ("
+                      << lifetime->all.count << " samples)\n";
+        }
+        if (recent) {
+            auto [x_mm, y_mm] = StatsStore::areaMm(*recent, *tablet_opt);
+            std::cout << "Last " << rolling_days << " days (binned): " << x_mm << " x " << y_mm << " mm, rotation "
+                      << recent->rotationDeg() << "°\n";
+        }
+        std::cout << "=================\n";
+    }
+
+    write_profile();
     return 0;
 }
\ No newline at end of file